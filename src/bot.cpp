@@ -0,0 +1,306 @@
+#include "bot.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+// a placement that loses the game is worse than every other placement
+constexpr double game_over_score = std::numeric_limits<double>::lowest();
+
+/**
+ * A Struct for a lock position of the current piece together with its
+ * rating.
+ */
+struct Candidate {
+    size_t lock;
+    int lines_cleared;
+    double score;
+};
+
+using candidates_t = std::array<Candidate, num_reach_states>;
+
+/**
+ * Locks the piece at the given location in the playfield and removes the
+ * full lines. Returns the number of cleared lines.
+ *
+ * Works on a copy of the playfield only, which is a lot cheaper than copying
+ * a whole TetrisGame.
+ */
+int place_piece(playfield_t& p, const Piece& piece,
+                const location_t& location) {
+    for (const auto& [a, b] : piece.location) {
+        p.at(a).at(b) = Tetromino::EMPTY;
+    }
+
+    for (const auto& [a, b] : location) {
+        p.at(a).at(b) = piece.tet_type;
+    }
+
+    // move all lines that are not full down, from the bottom up
+    int cleared = 0;
+    int target = field_height - 1;
+    for (int line = field_height - 1; line >= 0; --line) {
+        if (std::none_of(p.at(line).begin(), p.at(line).end(),
+                         [](Tetromino t) { return t == Tetromino::EMPTY; })) {
+            ++cleared;
+            continue;
+        }
+
+        if (target != line) {
+            p.at(target) = p.at(line);
+        }
+        --target;
+    }
+
+    for (; target >= 0; --target) {
+        p.at(target).fill(Tetromino::EMPTY);
+    }
+
+    return cleared;
+}
+
+/**
+ * Lets the next piece appear above the playfield and fall down one line like
+ * process_falldown() does. Returns false if it can not fall, so the game is
+ * over.
+ */
+bool spawn_piece(const playfield_t& p, Piece& piece) {
+    location_t old = piece.location;
+    for (auto& [a, b] : piece.location) {
+        ++a;
+
+        if (same_piece(old, {a, b})) {
+            continue;
+        }
+
+        if (a >= field_height || p.at(a).at(b) != Tetromino::EMPTY) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Rates all lock positions of the piece found by reach and writes them to
+ * candidates. Returns the number of candidates.
+ */
+size_t rate_candidates(const playfield_t& field, const Piece& piece,
+                       const Reachability& reach, int lines_before,
+                       candidates_t& candidates) {
+    for (size_t i = 0; i < reach.num_locks; ++i) {
+        playfield_t p = field;
+        int lines =
+            place_piece(p, piece, reach.location_of(reach.locks.at(i).state));
+
+        candidates.at(i) = {i, lines,
+                            evaluate_playfield(p, lines_before + lines)};
+    }
+
+    return reach.num_locks;
+}
+
+bool placement_fits(const Placement& p, const TetrisGame& game) {
+    return p.start.tet_type == game.cur_piece.tet_type &&
+           p.start.location == game.cur_piece.location &&
+           p.start.orientation == game.cur_piece.orientation;
+}
+
+double evaluate_playfield(const playfield_t& p, int lines_cleared) {
+    int aggregate_height = 0;
+    int holes = 0;
+    int bumpiness = 0;
+    int last_height = 0;
+
+    for (int col = 0; col < field_width; ++col) {
+        int height = 0;
+        for (int line = 0; line < field_height; ++line) {
+            if (p.at(line).at(col) != Tetromino::EMPTY) {
+                if (height == 0) {
+                    height = field_height - line;
+                }
+            } else if (height != 0) {
+                // empty cell below the top of the column
+                ++holes;
+            }
+        }
+
+        aggregate_height += height;
+        if (col > 0) {
+            bumpiness += std::abs(height - last_height);
+        }
+        last_height = height;
+    }
+
+    return -0.510066 * aggregate_height + 0.760666 * lines_cleared -
+           0.35663 * holes - 0.184483 * bumpiness;
+}
+
+/**
+ * Searches the placements for the given game. Calls publish for every
+ * improvement and stops early if cancelled returns true.
+ */
+template <typename Publish, typename Cancelled>
+void search_placements(const TetrisGame& game, Publish publish,
+                       Cancelled cancelled) {
+    Reachability reach;
+    reach.search(game);
+
+    candidates_t candidates;
+    size_t count =
+        rate_candidates(game.playfield, game.cur_piece, reach, 0, candidates);
+
+    // first only look at the current piece
+    std::sort(candidates.begin(), candidates.begin() + count,
+              [](const Candidate& a, const Candidate& b) {
+                  return a.score > b.score;
+              });
+
+    // paths that are too long can not be played
+    size_t playable = 0;
+    Placement placement;
+    auto make_placement = [&](const Candidate& c, double score) {
+        uint16_t state = reach.locks.at(c.lock).state;
+        placement.num_moves = reach.path_to(c.lock, placement.moves);
+        placement.score = score;
+        placement.location = reach.location_of(state);
+        placement.orientation = Reachability::orientation_of(state);
+        placement.start = game.cur_piece;
+        return placement.num_moves != 0;
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        if (make_placement(candidates.at(i), candidates.at(i).score)) {
+            candidates.at(playable++) = candidates.at(i);
+        }
+    }
+
+    if (playable == 0) {
+        return;
+    }
+
+    make_placement(candidates.at(0), candidates.at(0).score);
+    publish(placement);
+
+    // then also place the next piece, starting with the most promising
+    // placements of the current piece
+    Reachability next_reach;
+    candidates_t next_candidates;
+    double best_score = game_over_score;
+    for (size_t i = 0; i < playable; ++i) {
+        if (cancelled()) {
+            return;
+        }
+
+        const Candidate& c = candidates.at(i);
+        playfield_t field = game.playfield;
+        place_piece(field, game.cur_piece,
+                    reach.location_of(reach.locks.at(c.lock).state));
+        Piece next = game.next_piece;
+
+        double score = game_over_score;
+        if (spawn_piece(field, next)) {
+            next_reach.search(field, next);
+            size_t next_count = rate_candidates(
+                field, next, next_reach, c.lines_cleared, next_candidates);
+            for (size_t j = 0; j < next_count; ++j) {
+                score = std::max(score, next_candidates.at(j).score);
+            }
+        }
+
+        if (i == 0 || score > best_score) {
+            best_score = score;
+            make_placement(c, score);
+            publish(placement);
+        }
+    }
+}
+
+bool find_placement(const TetrisGame& game, Placement& p) {
+    bool found = false;
+    search_placements(
+        game,
+        [&](const Placement& best) {
+            p = best;
+            found = true;
+        },
+        [] { return false; });
+
+    return found;
+}
+
+Bot::Bot() : worker(&Bot::run, this) {}
+
+Bot::~Bot() {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        quit = true;
+    }
+
+    cv.notify_one();
+    worker.join();
+}
+
+void Bot::start_search(const TetrisGame& game) {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        job = game;
+        has_job = true;
+        has_best = false;
+    }
+
+    cv.notify_one();
+}
+
+bool Bot::best_placement(Placement& p) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!has_best) {
+        return false;
+    }
+
+    p = best;
+
+    return true;
+}
+
+void Bot::run() {
+    TetrisGame game;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            cv.wait(lock, [this] { return has_job || quit; });
+            if (quit) {
+                return;
+            }
+
+            game = job;
+            has_job = false;
+        }
+
+        search(game);
+    }
+}
+
+void Bot::search(const TetrisGame& game) {
+    search_placements(
+        game, [this](const Placement& p) { publish(p); },
+        [this] { return cancelled(); });
+}
+
+void Bot::publish(const Placement& p) {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // a newer search is waiting, so this result is outdated
+    if (has_job) {
+        return;
+    }
+
+    best = p;
+    has_best = true;
+}
+
+bool Bot::cancelled() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return has_job || quit;
+}
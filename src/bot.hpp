@@ -0,0 +1,131 @@
+#pragma once
+
+#include "reachability.hpp"
+#include "tetris.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+/**
+ * A Struct for a placement of the current piece found by the Bot.
+ *
+ * Saves the Moves that lead to the placement, ending with a hard drop, and
+ * the score the Bot gave it.
+ */
+struct Placement {
+    path_t moves{};
+    size_t num_moves = 0;
+    double score = 0;
+
+    /**
+     * Variable for the location and orientation of the piece after the
+     * hard drop.
+     */
+    location_t location{};
+    int orientation = 0;
+
+    /**
+     * Variable for the current piece the Moves were planned for. They only
+     * lead to the placement if the piece is still in this state.
+     */
+    Piece start{Tetromino::EMPTY, {}, 0};
+};
+
+/**
+ * Checks if the Moves of the placement can be applied to the current piece
+ * of the game, i.e. the piece was not moved since the search.
+ */
+bool placement_fits(const Placement& p, const TetrisGame& game);
+
+/**
+ * Rates a playfield after a piece was placed, higher is better.
+ *
+ * Uses the aggregate height, the number of holes and the bumpiness of the
+ * playfield and the number of lines that were cleared.
+ */
+double evaluate_playfield(const playfield_t& p, int lines_cleared);
+
+/**
+ * Searches the best placement for the current piece of game like the Bot,
+ * but on the calling thread and without a time limit. Returns false if the
+ * piece can not be placed.
+ */
+bool find_placement(const TetrisGame& game, Placement& p);
+
+/**
+ * A Struct for a bot that plays the game.
+ *
+ * The search runs on a background thread. It first rates every reachable
+ * lock position of the current piece and then refines the result by also
+ * placing the next piece. The best placement found so far can be taken at
+ * any time, so the game never has to wait for the search.
+ */
+struct Bot {
+    /**
+     * Bot constructor, starts the background thread.
+     */
+    Bot();
+
+    /**
+     * Bot destructor, stops the search and joins the background thread.
+     */
+    ~Bot();
+
+    Bot(const Bot&) = delete;
+    Bot& operator=(const Bot&) = delete;
+
+    /**
+     * Starts a new search for the current piece of the given game. A search
+     * that is still running gets cancelled.
+     */
+    void start_search(const TetrisGame& game);
+
+    /**
+     * Writes the best placement found so far to p. Returns false if the
+     * search has not found any placement yet.
+     */
+    bool best_placement(Placement& p);
+
+    /**
+     * The function that runs on the background thread.
+     */
+    void run();
+
+    /**
+     * Searches the placements for the given game and publishes every
+     * improvement. Returns early if the search gets cancelled.
+     */
+    void search(const TetrisGame& game);
+
+    /**
+     * Replaces the best placement if the search was not cancelled.
+     */
+    void publish(const Placement& p);
+
+    /**
+     * Checks if the current search should stop.
+     */
+    [[nodiscard]] bool cancelled();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    /**
+     * Variable for the game that should be searched next.
+     */
+    TetrisGame job;
+
+    /**
+     * Variable for the best placement of the current search.
+     */
+    Placement best;
+
+    bool has_job = false;
+    bool has_best = false;
+    bool quit = false;
+
+    std::thread worker;
+};
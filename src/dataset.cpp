@@ -0,0 +1,245 @@
+#include "dataset.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+static_assert(sizeof(DatasetHeader) <= dataset_data_offset,
+              "the header has to fit in front of the data");
+
+DatasetHeader make_dataset_header() {
+    DatasetHeader h{};
+    h.magic = dataset_magic;
+    h.version = dataset_version;
+    h.chunk_records = dataset_chunk_records;
+    h.num_records = 0;
+    h.data_offset = dataset_data_offset;
+
+    // the columns follow each other inside of a chunk
+    uint64_t offset = 0;
+    for (size_t c = 0; c < num_dataset_columns; ++c) {
+        uint64_t width = dataset_column_widths.at(c);
+        h.columns.at(c) = {offset, width};
+        offset += width * dataset_chunk_records;
+    }
+    h.chunk_size = offset;
+
+    return h;
+}
+
+void pack_board(const TetrisGame& game,
+                std::array<uint16_t, field_height>& board) {
+    for (int line = 0; line < field_height; ++line) {
+        board.at(line) = 0;
+        for (int col = 0; col < field_width; ++col) {
+            if (game.piece_at(line, col) != Tetromino::EMPTY &&
+                !same_piece(game.cur_piece.location, {line, col})) {
+                board.at(line) |= 1U << col;
+            }
+        }
+    }
+}
+
+DatasetWriter::DatasetWriter(std::string p, uint64_t chunks)
+    : prefix(std::move(p)),
+      shard_chunks(chunks),
+      header(make_dataset_header()),
+      buffer(header.chunk_size) {}
+
+bool DatasetWriter::add(const DatasetRecord& r) {
+    // the first record of a shard opens the file
+    if (!file.is_open()) {
+        file.open(prefix + '-' + std::to_string(shard) + ".tds",
+                  std::ios::binary | std::ios::trunc);
+        header.num_records = 0;
+        chunks_in_shard = 0;
+
+        if (!write_header()) {
+            return false;
+        }
+    }
+
+    auto store = [this](DatasetColumn c, const void* value) {
+        const DatasetColumnInfo& info =
+            header.columns.at(static_cast<size_t>(c));
+        std::memcpy(&buffer.at(info.offset + buffered * info.width), value,
+                    info.width);
+    };
+
+    auto cur_piece = static_cast<uint8_t>(r.cur_piece);
+    auto next_piece = static_cast<uint8_t>(r.next_piece);
+
+    store(DatasetColumn::BOARD, r.board.data());
+    store(DatasetColumn::CUR_PIECE, &cur_piece);
+    store(DatasetColumn::NEXT_PIECE, &next_piece);
+    store(DatasetColumn::LOCK_LINE, &r.lock_line);
+    store(DatasetColumn::LOCK_COL, &r.lock_col);
+    store(DatasetColumn::LOCK_ORIENTATION, &r.lock_orientation);
+    store(DatasetColumn::LINES_CLEARED, &r.lines_cleared);
+    store(DatasetColumn::SCORE_DELTA, &r.score_delta);
+
+    ++buffered;
+    ++total_records;
+
+    if (buffered == header.chunk_records) {
+        return write_chunk();
+    }
+
+    return true;
+}
+
+bool DatasetWriter::close() {
+    if (!file.is_open()) {
+        return true;
+    }
+
+    if (buffered > 0 && !write_chunk()) {
+        return false;
+    }
+
+    if (file.is_open()) {
+        if (!write_header()) {
+            return false;
+        }
+
+        file.close();
+    }
+
+    return !file.fail();
+}
+
+bool DatasetWriter::write_chunk() {
+    // the unused part of the last chunk is padded with zeros
+    if (buffered < header.chunk_records) {
+        for (const auto& info : header.columns) {
+            std::memset(&buffer.at(info.offset + buffered * info.width), 0,
+                        (header.chunk_records - buffered) * info.width);
+        }
+    }
+
+    file.seekp(static_cast<std::streamoff>(
+        header.data_offset + chunks_in_shard * header.chunk_size));
+    file.write(reinterpret_cast<const char*>(buffer.data()),  // NOLINT
+               static_cast<std::streamsize>(buffer.size()));
+
+    header.num_records += buffered;
+    buffered = 0;
+    ++chunks_in_shard;
+
+    if (chunks_in_shard == shard_chunks) {
+        // the next record starts a new shard
+        if (!write_header()) {
+            return false;
+        }
+
+        file.close();
+        ++shard;
+    }
+
+    return !file.fail();
+}
+
+bool DatasetWriter::write_header() {
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header),  // NOLINT
+               sizeof(header));
+
+    return !file.fail();
+}
+
+DatasetReader::~DatasetReader() { close(); }
+
+bool DatasetReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) == -1 ||
+        static_cast<uint64_t>(st.st_size) < dataset_data_offset) {
+        ::close(fd);
+        return false;
+    }
+
+    mapped_size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const uint8_t*>(p);
+
+    std::memcpy(&header, data, sizeof(header));
+
+    // everything except the number of records has to match the layout this
+    // program reads
+    DatasetHeader expected = make_dataset_header();
+    bool valid = header.magic == expected.magic &&
+                 header.version == expected.version &&
+                 header.chunk_records == expected.chunk_records &&
+                 header.data_offset == expected.data_offset &&
+                 header.chunk_size == expected.chunk_size;
+    for (size_t c = 0; valid && c < num_dataset_columns; ++c) {
+        valid = header.columns.at(c).offset == expected.columns.at(c).offset &&
+                header.columns.at(c).width == expected.columns.at(c).width;
+    }
+
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    // all chunks have to be in the file, without overflowing for a broken
+    // number of records
+    uint64_t chunks =
+        header.num_records / header.chunk_records +
+        (header.num_records % header.chunk_records == 0 ? 0 : 1);
+    if (chunks > (mapped_size - header.data_offset) / header.chunk_size) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void DatasetReader::close() {
+    if (data != nullptr) {
+        munmap(const_cast<uint8_t*>(data), mapped_size);  // NOLINT
+    }
+
+    data = nullptr;
+    mapped_size = 0;
+    header = {};
+}
+
+uint64_t DatasetReader::size() const { return header.num_records; }
+
+const uint8_t* DatasetReader::column(uint64_t index, DatasetColumn c) const {
+    const DatasetColumnInfo& info = header.columns.at(static_cast<size_t>(c));
+    uint64_t chunk = index / header.chunk_records;
+    uint64_t row = index % header.chunk_records;
+
+    return data + header.data_offset + chunk * header.chunk_size +
+           info.offset + row * info.width;
+}
+
+void DatasetReader::read(uint64_t index, DatasetRecord& r) const {
+    std::memcpy(r.board.data(), column(index, DatasetColumn::BOARD),
+                sizeof(r.board));
+    r.cur_piece =
+        static_cast<Tetromino>(*column(index, DatasetColumn::CUR_PIECE));
+    r.next_piece =
+        static_cast<Tetromino>(*column(index, DatasetColumn::NEXT_PIECE));
+    std::memcpy(&r.lock_line, column(index, DatasetColumn::LOCK_LINE), 1);
+    std::memcpy(&r.lock_col, column(index, DatasetColumn::LOCK_COL), 1);
+    r.lock_orientation = *column(index, DatasetColumn::LOCK_ORIENTATION);
+    r.lines_cleared = *column(index, DatasetColumn::LINES_CLEARED);
+    std::memcpy(&r.score_delta, column(index, DatasetColumn::SCORE_DELTA),
+                sizeof(r.score_delta));
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "tetris.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * File format of a dataset shard
+ *
+ * A shard starts with a DatasetHeader, the records follow at data_offset.
+ * The records are stored in chunks of chunk_records records. Inside of a
+ * chunk every column is stored on its own, so the value of column c for
+ * record i is at
+ *
+ *   data_offset + (i / chunk_records) * chunk_size +
+ *   columns[c].offset + (i % chunk_records) * columns[c].width
+ *
+ * The last chunk is padded with zeros, so every chunk has the same size and
+ * a record can be read from a memory mapped shard without any parsing.
+ * All values are stored in the byte order of the machine that wrote them.
+ */
+constexpr std::array<char, 8> dataset_magic = {'T', 'E', 'T', 'R',
+                                               'I', 'S', 'D', 'S'};
+constexpr uint32_t dataset_version = 1;
+constexpr uint64_t dataset_data_offset = 4096;
+constexpr uint32_t dataset_chunk_records = 4096;
+
+/**
+ * Enum with all columns of a dataset record.
+ */
+enum class DatasetColumn {
+    BOARD,
+    CUR_PIECE,
+    NEXT_PIECE,
+    LOCK_LINE,
+    LOCK_COL,
+    LOCK_ORIENTATION,
+    LINES_CLEARED,
+    SCORE_DELTA,
+    COUNT
+};
+
+constexpr size_t num_dataset_columns =
+    static_cast<size_t>(DatasetColumn::COUNT);
+
+/**
+ * Variable for the width in bytes of every column.
+ */
+constexpr std::array<uint32_t, num_dataset_columns> dataset_column_widths = {
+    field_height * sizeof(uint16_t), 1, 1, 1, 1, 1, 1, sizeof(uint16_t)};
+
+/**
+ * A Struct for a single sample of the dataset.
+ */
+struct DatasetRecord {
+    /**
+     * Variable for the occupied cells of the playfield without the current
+     * piece, one line per entry and one bit per column.
+     */
+    std::array<uint16_t, field_height> board;
+
+    Tetromino cur_piece;
+    Tetromino next_piece;
+
+    /**
+     * Variable for the chosen placement, the line and column of the top left
+     * corner of the piece and its orientation.
+     *
+     * @see orientation_cells()
+     */
+    int8_t lock_line;
+    int8_t lock_col;
+    uint8_t lock_orientation;
+
+    uint8_t lines_cleared;
+    uint16_t score_delta;
+};
+
+/**
+ * A Struct for the position of a column inside of a chunk.
+ */
+struct DatasetColumnInfo {
+    uint64_t offset;
+    uint64_t width;
+};
+
+/**
+ * A Struct for the header at the start of every shard, it is also the index
+ * of the columns.
+ */
+struct DatasetHeader {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t chunk_records;
+    uint64_t num_records;
+    uint64_t data_offset;
+    uint64_t chunk_size;
+    std::array<DatasetColumnInfo, num_dataset_columns> columns;
+};
+
+/**
+ * Returns the header of an empty shard.
+ */
+DatasetHeader make_dataset_header();
+
+/**
+ * Packs the playfield of the game without the current piece into lines of
+ * bits.
+ */
+void pack_board(const TetrisGame& game,
+                std::array<uint16_t, field_height>& board);
+
+/**
+ * A Struct for writing records into shards.
+ *
+ * The records of one chunk are collected in a buffer and then written to the
+ * current shard. A new shard is started when the current one has
+ * shard_chunks chunks, so a single writer never needs more memory than one
+ * chunk.
+ */
+struct DatasetWriter {
+    /**
+     * DatasetWriter constructor. The shards are called
+     * <prefix>-<shard number>.tds.
+     */
+    DatasetWriter(std::string prefix, uint64_t shard_chunks);
+
+    /**
+     * Adds a record and writes the buffer if the chunk is full. Returns
+     * false if writing failed.
+     */
+    [[nodiscard]] bool add(const DatasetRecord& r);
+
+    /**
+     * Writes the remaining records and the final header of the current
+     * shard. Returns false if writing failed.
+     */
+    [[nodiscard]] bool close();
+
+    /**
+     * Writes the buffer as one chunk to the current shard and opens a new
+     * shard if needed. Returns false if writing failed.
+     */
+    [[nodiscard]] bool write_chunk();
+
+    /**
+     * Writes the header of the current shard with the number of records.
+     */
+    [[nodiscard]] bool write_header();
+
+    std::string prefix;
+    uint64_t shard_chunks;
+
+    DatasetHeader header;
+
+    /**
+     * Variable for the records of the current chunk, column by column.
+     */
+    std::vector<uint8_t> buffer;
+
+    /**
+     * Variable for the number of records in the buffer.
+     */
+    uint32_t buffered = 0;
+
+    std::ofstream file;
+    uint64_t shard = 0;
+    uint64_t chunks_in_shard = 0;
+
+    /**
+     * Variable for the number of records written by this writer.
+     */
+    uint64_t total_records = 0;
+};
+
+/**
+ * A Struct for reading a shard by memory mapping it.
+ */
+struct DatasetReader {
+    DatasetReader() = default;
+
+    /**
+     * DatasetReader destructor, unmaps the shard.
+     */
+    ~DatasetReader();
+
+    DatasetReader(const DatasetReader&) = delete;
+    DatasetReader& operator=(const DatasetReader&) = delete;
+
+    /**
+     * Maps the shard at the given path and checks its header against
+     * make_dataset_header(). Returns false and stays closed if the file is
+     * not a valid shard.
+     */
+    [[nodiscard]] bool open(const std::string& path);
+
+    /**
+     * Unmaps the shard, afterwards size() is 0.
+     */
+    void close();
+
+    /**
+     * Returns the number of records in the shard.
+     */
+    [[nodiscard]] uint64_t size() const;
+
+    /**
+     * Returns a pointer to the value of column c for the record with the
+     * given index.
+     */
+    [[nodiscard]] const uint8_t* column(uint64_t index, DatasetColumn c) const;
+
+    /**
+     * Reads the record with the given index.
+     */
+    void read(uint64_t index, DatasetRecord& r) const;
+
+    const uint8_t* data = nullptr;
+    size_t mapped_size = 0;
+    DatasetHeader header{};
+};
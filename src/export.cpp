@@ -0,0 +1,208 @@
+#include "bot.hpp"
+#include "dataset.hpp"
+#include "profile.hpp"
+#include "tetris.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Reads a non negative number from a commandline argument.
+ */
+bool parse_number(const char* arg, uint64_t& value) {
+    // reading an unsigned number would wrap a negative one around, and
+    // whitespace would hide the sign
+    if (std::isdigit(static_cast<unsigned char>(*arg)) == 0) {
+        return false;
+    }
+
+    std::istringstream iss{arg};
+    return static_cast<bool>(iss >> value);
+}
+
+/**
+ * Plays a game with the given seed using find_placement() and adds a record
+ * for every placed piece to the writer. There is no gravity, so the bot
+ * can always reach every placement. Returns false if writing failed.
+ */
+bool play_game(uint64_t seed, uint64_t max_pieces, DatasetWriter& writer) {
+    TetrisGame game{static_cast<std::mt19937::result_type>(seed)};
+    Placement p;
+    DatasetRecord r{};
+
+    // let the first piece appear
+    bool game_running = game.next_state(Move::MOVE_DOWN);
+
+    for (uint64_t piece = 0; game_running && piece < max_pieces; ++piece) {
+        if (!find_placement(game, p)) {
+            break;
+        }
+
+        pack_board(game, r.board);
+        r.cur_piece = game.cur_piece.tet_type;
+        r.next_piece = game.next_piece.tet_type;
+
+        // the top left corner of the piece
+        const location_t& cells =
+            orientation_cells(game.cur_piece.tet_type, p.orientation);
+        r.lock_line =
+            static_cast<int8_t>(p.location.at(0).first - cells.at(0).first);
+        r.lock_col =
+            static_cast<int8_t>(p.location.at(0).second - cells.at(0).second);
+        r.lock_orientation = static_cast<uint8_t>(p.orientation);
+
+        int lines_before = game.total_lines_cleared;
+        int score_before = game.cur_score;
+
+        for (size_t i = 0; game_running && i < p.num_moves; ++i) {
+            game_running = game.apply_move(p.moves.at(i));
+        }
+
+        r.lines_cleared =
+            static_cast<uint8_t>(game.total_lines_cleared - lines_before);
+        r.score_delta = static_cast<uint16_t>(game.cur_score - score_before);
+
+        if (!writer.add(r)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0]  // NOLINT
+                  << " <output prefix> [--games N] [--threads N] [--seed N]"
+                     " [--max-pieces N] [--shard-chunks N] [--profile]\n";
+        return 1;
+    }
+
+    std::string prefix{argv[1]};  // NOLINT
+    uint64_t games = 100;
+    uint64_t threads = std::max(std::thread::hardware_concurrency(), 1U);
+    uint64_t seed = 0;
+    uint64_t max_pieces = 1000;
+    uint64_t shard_chunks = 256;
+    [[maybe_unused]] bool profile = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg{argv[i]};  // NOLINT
+        uint64_t value;
+
+        if (arg == "--profile") {
+#ifdef TETRIS_PROFILE
+            profile = true;
+            continue;
+#else
+            std::cout << "--profile needs a build with make PROFILE=1\n";
+            return 1;
+#endif
+        }
+
+        if (i + 1 >= argc || !parse_number(argv[++i], value)) {  // NOLINT
+            std::cout << arg << " expects a number\n";
+            return 1;
+        }
+
+        if (arg == "--games") {
+            games = value;
+        } else if (arg == "--threads") {
+            threads = std::max<uint64_t>(value, 1);
+        } else if (arg == "--seed") {
+            seed = value;
+        } else if (arg == "--max-pieces") {
+            max_pieces = value;
+        } else if (arg == "--shard-chunks") {
+            shard_chunks = std::max<uint64_t>(value, 1);
+        } else {
+            std::cout << "Unknown argument " << arg << '\n';
+            return 1;
+        }
+    }
+
+    // every thread writes its own shards and takes the next game when it
+    // is done with one
+    std::atomic<uint64_t> next_game{0};
+    std::vector<uint64_t> records(threads, 0);
+    std::vector<char> failed(threads, 0);
+    std::vector<std::thread> workers;
+
+#ifdef TETRIS_PROFILE
+    // every thread measures the engine on its own, the results are added up
+    std::optional<Profiler> profiler;
+    std::mutex profiler_mutex;
+    if (profile) {
+        profiler.emplace(false);
+    }
+#endif
+
+    for (uint64_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+#ifdef TETRIS_PROFILE
+            std::optional<Profiler> thread_profiler;
+            if (profile) {
+                thread_profiler.emplace();
+                active_profiler = &*thread_profiler;
+            }
+#endif
+
+            DatasetWriter writer{prefix + '-' + std::to_string(t),
+                                 shard_chunks};
+
+            for (uint64_t g = next_game++; g < games; g = next_game++) {
+                if (!play_game(seed + g, max_pieces, writer)) {
+                    failed.at(t) = 1;
+                    return;
+                }
+            }
+
+            failed.at(t) = writer.close() ? 0 : 1;
+            records.at(t) = writer.total_records;
+
+#ifdef TETRIS_PROFILE
+            if (thread_profiler) {
+                active_profiler = nullptr;
+
+                std::lock_guard<std::mutex> lock{profiler_mutex};
+                profiler->merge(*thread_profiler);
+            }
+#endif
+        });
+    }
+
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+        std::cout << "Writing the dataset failed\n";
+        return 1;
+    }
+
+    uint64_t total = 0;
+    for (uint64_t r : records) {
+        total += r;
+    }
+
+    std::cout << "Wrote " << total << " records from " << games
+              << " games.\n";
+
+#ifdef TETRIS_PROFILE
+    if (profiler) {
+        std::cout << '\n';
+        profiler->report(std::cout);
+    }
+#endif
+
+    return 0;
+}
@@ -44,7 +44,7 @@ void draw_lines(WINDOW* w, int lines) {
     wprintw(w, "Lines");
 
     wmove(w, 3, 1);
-    wprintw(w, std::to_string(lines).c_str());
+    wprintw(w, "%d", lines);
 
     wnoutrefresh(w);
 }
@@ -56,7 +56,7 @@ void draw_score(WINDOW* w, int score) {
     wprintw(w, "Score");
 
     wmove(w, 3, 1);
-    wprintw(w, std::to_string(score).c_str());
+    wprintw(w, "%d", score);
 
     wnoutrefresh(w);
 }
@@ -85,7 +85,7 @@ void draw_level(WINDOW* w, int level) {
     wprintw(w, "Level");
 
     wmove(w, 3, 1);
-    wprintw(w, std::to_string(level).c_str());
+    wprintw(w, "%d", level);
 
     wnoutrefresh(w);
 }
@@ -0,0 +1,180 @@
+#include "input.hpp"
+
+#include <algorithm>
+#include <ncurses.h>
+
+bool InputQueue::push(const InputEvent& e) {
+    if (count == events.size()) {
+        return false;
+    }
+
+    // keep the queue ordered by time, events that happened earlier move
+    // in front of the later ones
+    size_t i = count;
+    for (; i > 0; --i) {
+        const InputEvent& before = events.at((head + i - 1) % events.size());
+        if (before.time <= e.time) {
+            break;
+        }
+
+        events.at((head + i) % events.size()) = before;
+    }
+
+    events.at((head + i) % events.size()) = e;
+    ++count;
+
+    return true;
+}
+
+bool InputQueue::pop(InputEvent& e) {
+    if (count == 0) {
+        return false;
+    }
+
+    e = events.at(head);
+    head = (head + 1) % events.size();
+    --count;
+
+    return true;
+}
+
+void InputQueue::clear() {
+    head = 0;
+    count = 0;
+}
+
+InputHandler::InputHandler(InputConfig c) : config(c), queue() {
+    keys.at(0).move = Move::MOVE_LEFT;
+    keys.at(1).move = Move::MOVE_RIGHT;
+    keys.at(2).move = Move::MOVE_DOWN;
+}
+
+Command InputHandler::poll() {
+    Command cmd = Command::NONE;
+
+    // read keys until there are no more pending keys or a command was read
+    for (int ch = getch(); ch != ERR; ch = getch()) {
+        auto now = input_clock::now();
+
+        switch (ch) {
+            case KEY_LEFT:
+                press(Move::MOVE_LEFT, now);
+                break;
+            case KEY_RIGHT:
+                press(Move::MOVE_RIGHT, now);
+                break;
+            case KEY_DOWN:
+                press(Move::MOVE_DOWN, now);
+                break;
+            case KEY_UP:
+                press(Move::MOVE_UP, now);
+                break;
+            case 'a':
+                press(Move::ROTATE_LEFT, now);
+                break;
+            case 's':
+                press(Move::ROTATE_RIGHT, now);
+                break;
+            case 'p':
+                cmd = Command::PAUSE;
+                break;
+            case 'q':
+                cmd = Command::QUIT;
+                break;
+            default:
+                break;
+        }
+
+        if (cmd != Command::NONE) {
+            break;
+        }
+    }
+
+    auto_shift(input_clock::now());
+
+    return cmd;
+}
+
+void InputHandler::reset() {
+    for (auto& k : keys) {
+        k.active = false;
+        k.held = false;
+    }
+
+    queue.clear();
+}
+
+void InputHandler::press(Move m, input_clock::time_point t) {
+    KeyState* k = key_state(m);
+
+    // keys without auto repeat are passed on directly
+    if (k == nullptr) {
+        queue.push({m, t});
+        return;
+    }
+
+    // pressing one direction releases the other one
+    if (m == Move::MOVE_LEFT || m == Move::MOVE_RIGHT) {
+        Move opposite =
+            m == Move::MOVE_LEFT ? Move::MOVE_RIGHT : Move::MOVE_LEFT;
+        KeyState* other = key_state(opposite);
+        other->active = false;
+        other->held = false;
+    }
+
+    auto gap = t - k->last_seen;
+    if (!k->active || gap > config.repeat_delay ||
+        (!k->held && t - k->first_press < config.min_repeat_delay)) {
+        // a new press, the terminal can not repeat a key this early
+        k->first_press = t;
+        k->last_shift = t;
+        k->held = false;
+        queue.push({m, t});
+    } else if (gap > config.release_timeout) {
+        // either another tap or the first auto repeat of the terminal
+        k->last_shift = t;
+        k->held = false;
+        queue.push({m, t});
+    } else {
+        // the terminal repeats the key, the auto shift takes over
+        k->held = true;
+    }
+
+    k->active = true;
+    k->last_seen = t;
+}
+
+void InputHandler::auto_shift(input_clock::time_point now) {
+    for (auto& k : keys) {
+        if (!k.held) {
+            continue;
+        }
+
+        // the last repeat of the terminal is the last proof that the key is
+        // still held, so no moves are made after it
+        auto until = std::min(now, k.last_seen);
+        auto next =
+            std::max(k.last_shift + config.arr, k.first_press + config.das);
+        for (; next <= until; next += config.arr) {
+            if (!queue.push({k.move, next})) {
+                break;
+            }
+
+            k.last_shift = next;
+        }
+
+        if (now - k.last_seen > config.release_timeout) {
+            k.held = false;
+        }
+    }
+}
+
+KeyState* InputHandler::key_state(Move m) {
+    for (auto& k : keys) {
+        if (k.move == m) {
+            return &k;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "tetris.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * Monotonic clock used to timestamp the user input.
+ */
+using input_clock = std::chrono::steady_clock;
+
+constexpr size_t input_queue_size = 64;
+constexpr size_t num_repeating_keys = 3;
+
+/**
+ * Enum with the commands that are handled by the user interface instead of
+ * the game.
+ */
+enum class Command { NONE, PAUSE, QUIT };
+
+/**
+ * A Struct for a single Move together with the time it happened.
+ */
+struct InputEvent {
+    Move move;
+    input_clock::time_point time;
+};
+
+/**
+ * A Struct for the timing of held keys.
+ *
+ * A terminal only reports key presses, so a key counts as held as long as
+ * the terminal keeps sending its auto repeat for it.
+ */
+struct InputConfig {
+    /**
+     * Delayed auto shift, the time a key has to be held before the piece
+     * starts moving on its own.
+     *
+     * A key is only known to be held once the terminal repeats it, so a
+     * value below the repeat delay of the terminal has no effect.
+     */
+    std::chrono::milliseconds das{170};
+
+    /**
+     * Auto repeat rate, the time between two moves while a key is held.
+     */
+    std::chrono::milliseconds arr{50};
+
+    /**
+     * A key counts as released if the terminal did not repeat it for this
+     * long. Has to be longer than the repeat interval of the terminal.
+     */
+    std::chrono::milliseconds release_timeout{100};
+
+    /**
+     * The shortest pause the terminal makes between the first press of a key
+     * and its first auto repeat. Presses that come sooner are quick taps.
+     */
+    std::chrono::milliseconds min_repeat_delay{200};
+
+    /**
+     * The longest pause the terminal makes between the first press of a key
+     * and its first auto repeat.
+     */
+    std::chrono::milliseconds repeat_delay{600};
+};
+
+/**
+ * A fixed size ring buffer of InputEvents that never allocates. The events
+ * are ordered by their time.
+ */
+struct InputQueue {
+    /**
+     * Adds an event behind all events that did not happen later. Returns
+     * false and drops the event if the queue is full.
+     */
+    bool push(const InputEvent& e);
+
+    /**
+     * Removes the first event of the queue and writes it to e. Returns false
+     * if the queue is empty.
+     */
+    bool pop(InputEvent& e);
+
+    /**
+     * Removes all events from the queue.
+     */
+    void clear();
+
+    std::array<InputEvent, input_queue_size> events{};
+    size_t head = 0;
+    size_t count = 0;
+};
+
+/**
+ * A Struct for the state of a key that supports auto repeat.
+ */
+struct KeyState {
+    Move move = Move::NONE;
+    bool active = false;
+    bool held = false;
+    input_clock::time_point first_press;
+    input_clock::time_point last_seen;
+    input_clock::time_point last_shift;
+};
+
+/**
+ * A Struct for reading the keyboard.
+ *
+ * Reads all pending keys with getch() and turns them into timestamped
+ * InputEvents. Held keys for moving left, right and down are repeated with
+ * the delayed auto shift and auto repeat rate from the InputConfig.
+ */
+struct InputHandler {
+    /**
+     * InputHandler constructor.
+     */
+    explicit InputHandler(InputConfig config = {});
+
+    /**
+     * Reads all pending keys into the queue and adds the auto repeated moves
+     * for held keys. Returns the first Command that was read, the keys after
+     * it are left for the next call.
+     */
+    Command poll();
+
+    /**
+     * Releases all keys and clears the queue, e.g. after a pause.
+     */
+    void reset();
+
+    /**
+     * Handles a single key press of a Move at the given time.
+     */
+    void press(Move m, input_clock::time_point t);
+
+    /**
+     * Adds the moves for all held keys that are due until the given time.
+     */
+    void auto_shift(input_clock::time_point now);
+
+    /**
+     * Returns the KeyState for the given Move or nullptr if the Move does
+     * not support auto repeat.
+     */
+    [[nodiscard]] KeyState* key_state(Move m);
+
+    InputConfig config;
+
+    InputQueue queue;
+
+    std::array<KeyState, num_repeating_keys> keys;
+};
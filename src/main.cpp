@@ -1,21 +1,64 @@
+#include "bot.hpp"
 #include "graphics.hpp"
+#include "input.hpp"
+#include "profile.hpp"
 #include "tetris.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <ncurses.h>
+#include <optional>
 #include <sstream>
+#include <string>
+
+// the bot places its piece when the current piece is about to fall down
+constexpr int autoplay_deadline = 5;
+
+/**
+ * Reads a non negative number from a commandline argument.
+ */
+bool parse_number(const char* arg, int& value) {
+    std::istringstream iss{arg};
+    return (iss >> value) && value >= 0;
+}
 
 int main(int argc, char* argv[]) {
     // create Tetris Game
     TetrisGame game;
+    InputConfig input_config;
+    bool autoplay = false;
+    [[maybe_unused]] bool profile = false;
 
-    // set correct level depending on commandline arguments
-    if (argc >= 2) {
-        std::istringstream iss{argv[1]};  // NOLINT
-        int level;
+    // handle the commandline arguments
+    for (int i = 1; i < argc; ++i) {
+        std::string arg{argv[i]};  // NOLINT
 
-        if (iss >> level) {
-            if (level < 0) {
+        if (arg == "--autoplay") {
+            autoplay = true;
+        } else if (arg == "--profile") {
+#ifdef TETRIS_PROFILE
+            profile = true;
+#else
+            std::cout << "--profile needs a build with make PROFILE=1\n";
+            return 1;
+#endif
+        } else if (arg == "--das" || arg == "--arr") {
+            int ms;
+            if (i + 1 >= argc || !parse_number(argv[++i], ms)) {  // NOLINT
+                std::cout << arg << " expects a number of milliseconds\n";
+                return 1;
+            }
+
+            if (arg == "--das") {
+                input_config.das = std::chrono::milliseconds{ms};
+            } else {
+                input_config.arr = std::chrono::milliseconds{std::max(ms, 1)};
+            }
+        } else {
+            // set correct level
+            int level;
+            if (!parse_number(argv[i], level)) {  // NOLINT
                 std::cout << "The level should not be less than 0\n";
                 return 1;
             }
@@ -42,58 +85,105 @@ int main(int argc, char* argv[]) {
     WINDOW* next_window = newwin(7, 14, 10, 2 * field_width + 2);
     WINDOW* level_window = newwin(5, 14, 17, 2 * field_width + 2);
 
-    bool game_running = true;
-    Move m = Move::MOVE_DOWN;
+    InputHandler input{input_config};
+    // the search thread of the bot is only started in autoplay mode
+    std::optional<Bot> bot;
+    if (autoplay) {
+        bot.emplace();
+    }
+    Placement placement;
+    bool bot_searching = false;
+
+#ifdef TETRIS_PROFILE
+    // measure the engine and the drawing of the main thread
+    std::optional<Profiler> profiler;
+    if (profile) {
+        profiler.emplace();
+        active_profiler = &*profiler;
+    }
+    uint64_t start_allocations = allocation_count();
+#endif
+
+    // let the first piece appear
+    bool game_running = game.next_state(Move::MOVE_DOWN);
+    auto last_tick = input_clock::now();
+
+    // every millisecond until the given time is one tick
+    auto advance = [&](input_clock::time_point t) {
+        while (t - last_tick >= std::chrono::milliseconds{1}) {
+            last_tick += std::chrono::milliseconds{1};
+            if (!game.tick()) {
+                return false;
+            }
+        }
+
+        return true;
+    };
 
     // main game loop
     while (game_running) {
-        // handle the last input and check if the game is over or not
-        game_running = game.next_state(m);
-        draw_board(board, game);
-        draw_lines(lines_window, game.total_lines_cleared);
-        draw_score(score_window, game.cur_score);
-        draw_next(next_window, game.next_piece);
-        draw_level(level_window, game.cur_level);
-
-        // actually show the board
-        doupdate();
-
-        switch (getch()) {
-            case KEY_LEFT:
-                m = Move::MOVE_LEFT;
-                break;
-            case KEY_RIGHT:
-                m = Move::MOVE_RIGHT;
-                break;
-            case KEY_DOWN:
-                m = Move::MOVE_DOWN;
-                break;
-            case KEY_UP:
-                m = Move::MOVE_UP;
-                break;
-            case 'a':
-                m = Move::ROTATE_LEFT;
-                break;
-            case 's':
-                m = Move::ROTATE_RIGHT;
-                break;
-            case 'p':
-                erase();
-                refresh();
-                wmove(board, field_height / 2, field_width - 2);
-                wprintw(board, "PAUSED");  // NOLINT
-                wrefresh(board);
-                timeout(-1);
-                getch();
-                timeout(1);
-                m = Move::NONE;
-                break;
-            case 'q':
-                game_running = false;
-                break;
-            default:
-                m = Move::NONE;
-                break;
+        {
+            PROFILE_SCOPE(ProfiledFunction::DRAW);
+            draw_board(board, game);
+            draw_lines(lines_window, game.total_lines_cleared);
+            draw_score(score_window, game.cur_score);
+            draw_next(next_window, game.next_piece);
+            draw_level(level_window, game.cur_level);
+
+            // actually show the board
+            doupdate();
+        }
+
+        // read all pending keys
+        Command cmd = input.poll();
+        if (cmd == Command::QUIT) {
+            break;
+        }
+
+        if (bot) {
+            // the bot controls the piece
+            input.queue.clear();
+
+            if (!bot_searching) {
+                bot->start_search(game);
+                bot_searching = true;
+            } else if (game.ticks_till_falldown <= autoplay_deadline &&
+                       bot->best_placement(placement)) {
+                if (placement_fits(placement, game)) {
+                    for (size_t i = 0;
+                         game_running && i < placement.num_moves; ++i) {
+                        game_running = game.apply_move(placement.moves.at(i));
+                    }
+                }
+
+                // the piece moved since the search started, search again
+                bot_searching = false;
+            }
+        }
+
+        // apply all moves in the order they happened
+        InputEvent e;
+        while (game_running && input.queue.pop(e)) {
+            game_running = advance(e.time) && game.apply_move(e.move);
+        }
+
+        if (game_running) {
+            game_running = advance(input_clock::now());
+        }
+
+        if (cmd == Command::PAUSE) {
+            erase();
+            refresh();
+            wmove(board, field_height / 2, field_width - 2);
+            wprintw(board, "PAUSED");  // NOLINT
+            wrefresh(board);
+            timeout(-1);
+            getch();
+            timeout(1);
+
+            // held keys and passed time do not count while paused
+            input.reset();
+            last_tick = input_clock::now();
         }
     }
 
@@ -104,5 +194,16 @@ int main(int argc, char* argv[]) {
     std::cout << "You finished the game with " << game.cur_score
               << " points.\n";
 
+#ifdef TETRIS_PROFILE
+    if (profiler) {
+        active_profiler = nullptr;
+
+        std::cout << '\n';
+        profiler->report(std::cout);
+        std::cout << "\nAllocations during the game: "
+                  << allocation_count() - start_allocations << '\n';
+    }
+#endif
+
     return 0;
 }
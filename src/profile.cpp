@@ -0,0 +1,223 @@
+#include "profile.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <linux/perf_event.h>
+#include <new>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+thread_local Profiler* active_profiler = nullptr;
+
+namespace {
+
+thread_local uint64_t allocations = 0;
+
+void* counting_new(size_t size) {
+    ++allocations;
+
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+constexpr std::array<uint64_t, num_perf_counters> perf_events = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+constexpr std::array<const char*, num_profiled_functions> function_names = {
+    "next_state",       "apply_move", "tick", "process_falldown",
+    "clear_full_lines", "draw_*"};
+
+int open_counter(uint64_t config, int group_fd) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = group_fd == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // measure the calling thread on any cpu
+    return static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return counting_new(size); }
+void* operator new[](size_t size) { return counting_new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t /*size*/) noexcept { std::free(p); }
+void operator delete[](void* p, size_t /*size*/) noexcept { std::free(p); }
+
+uint64_t allocation_count() { return allocations; }
+
+Profiler::Profiler(bool open_counters) {
+    fds.fill(-1);
+
+    if (!open_counters) {
+        // the merged Profilers decide if there are counters to report
+        counters_available = true;
+        return;
+    }
+
+    for (size_t i = 0; i < num_perf_counters; ++i) {
+        fds.at(i) = open_counter(perf_events.at(i), fds.at(0));
+        if (fds.at(i) == -1) {
+            // without all counters only the time gets measured
+            return;
+        }
+    }
+
+    ioctl(fds.at(0), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds.at(0), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    counters_available = true;
+}
+
+Profiler::~Profiler() {
+    for (int fd : fds) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+void Profiler::read_counters(perf_values_t& values) const {
+    // layout of a group read: number of counters followed by the values
+    std::array<uint64_t, num_perf_counters + 1> buf{};
+
+    if (!counters_available || fds.at(0) == -1 ||
+        read(fds.at(0), buf.data(), sizeof(buf)) != sizeof(buf)) {
+        values.fill(0);
+        return;
+    }
+
+    for (size_t i = 0; i < num_perf_counters; ++i) {
+        values.at(i) = buf.at(i + 1);
+    }
+}
+
+void Profiler::report(std::ostream& os) const {
+    uint64_t pieces =
+        functions.at(static_cast<size_t>(ProfiledFunction::CLEAR_FULL_LINES))
+            .calls;
+
+    os << "Profile over " << pieces << " pieces";
+    if (!counters_available) {
+        os << " (hardware counters not available, timing only)";
+    }
+    os << "\n\n";
+
+    os << "Measurements without the nested functions, only total ns/call "
+          "includes them\n\n";
+
+    os << std::left << std::setw(18) << "function" << std::right
+       << std::setw(10) << "calls" << std::setw(12) << "ns/call"
+       << std::setw(16) << "total ns/call" << std::setw(10) << "allocs";
+    if (counters_available) {
+        os << std::setw(8) << "IPC" << std::setw(16) << "cache-miss/pc"
+           << std::setw(16) << "branch-miss/pc";
+    }
+    os << '\n';
+
+    for (size_t i = 0; i < num_profiled_functions; ++i) {
+        const FunctionProfile& f = functions.at(i);
+        uint64_t calls = f.calls;
+
+        // e.g. nothing gets drawn in tetris-export
+        if (calls == 0) {
+            continue;
+        }
+
+        double per_piece = pieces == 0 ? 0 : 1.0 / static_cast<double>(pieces);
+
+        os << std::left << std::setw(18) << function_names.at(i) << std::right
+           << std::setw(10) << f.calls << std::setw(12)
+           << f.nanoseconds / calls << std::setw(16)
+           << f.total_nanoseconds / calls << std::setw(10) << f.allocations;
+
+        if (counters_available) {
+            uint64_t cycles = std::max<uint64_t>(f.counters.at(0), 1);
+            os << std::fixed << std::setprecision(2) << std::setw(8)
+               << static_cast<double>(f.counters.at(1)) /
+                      static_cast<double>(cycles)
+               << std::setw(16)
+               << static_cast<double>(f.counters.at(2)) * per_piece
+               << std::setw(16)
+               << static_cast<double>(f.counters.at(3)) * per_piece;
+        }
+        os << '\n';
+    }
+}
+
+void Profiler::merge(const Profiler& other) {
+    counters_available = counters_available && other.counters_available;
+
+    for (size_t i = 0; i < num_profiled_functions; ++i) {
+        FunctionProfile& f = functions.at(i);
+        const FunctionProfile& o = other.functions.at(i);
+        f.calls += o.calls;
+        f.nanoseconds += o.nanoseconds;
+        f.total_nanoseconds += o.total_nanoseconds;
+        f.allocations += o.allocations;
+        for (size_t c = 0; c < num_perf_counters; ++c) {
+            f.counters.at(c) += o.counters.at(c);
+        }
+    }
+}
+
+void ProfileScope::start() {
+    parent = profiler->innermost;
+    profiler->innermost = this;
+
+    enter_time = std::chrono::steady_clock::now();
+    start_allocations = allocations;
+    profiler->read_counters(start_counters);
+
+    // take the time last so the reading of the counters is not measured
+    start_time = std::chrono::steady_clock::now();
+}
+
+void ProfileScope::stop() {
+    auto end_time = std::chrono::steady_clock::now();
+    perf_values_t end_counters;
+    profiler->read_counters(end_counters);
+
+    uint64_t nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time -
+                                                             start_time)
+            .count();
+    uint64_t new_allocations = allocations - start_allocations;
+
+    FunctionProfile& f = profiler->functions.at(static_cast<size_t>(function));
+    ++f.calls;
+    f.total_nanoseconds += nanoseconds;
+    f.nanoseconds += nanoseconds - std::min(nanoseconds, child_nanoseconds);
+    f.allocations += new_allocations - child_allocations;
+    for (size_t i = 0; i < num_perf_counters; ++i) {
+        uint64_t value = end_counters.at(i) - start_counters.at(i);
+        f.counters.at(i) += value - std::min(value, child_counters.at(i));
+    }
+
+    profiler->innermost = parent;
+    if (parent != nullptr) {
+        // the parent also does not count the time spent in start() and
+        // stop() of this scope
+        parent->child_nanoseconds +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - enter_time)
+                .count();
+        parent->child_allocations += new_allocations;
+        for (size_t i = 0; i < num_perf_counters; ++i) {
+            parent->child_counters.at(i) +=
+                end_counters.at(i) - start_counters.at(i);
+        }
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * Profiling is only compiled in with TETRIS_PROFILE (make PROFILE=1), so the
+ * default build neither measures the engine nor replaces operator new.
+ */
+#ifdef TETRIS_PROFILE
+#define PROFILE_SCOPE(f) ProfileScope profile_scope{f}
+#else
+#define PROFILE_SCOPE(f)
+#endif
+
+constexpr size_t num_perf_counters = 4;
+
+using perf_values_t = std::array<uint64_t, num_perf_counters>;
+
+/**
+ * Enum with all the functions that get measured in profile mode.
+ */
+enum class ProfiledFunction {
+    NEXT_STATE,
+    APPLY_MOVE,
+    TICK,
+    PROCESS_FALLDOWN,
+    CLEAR_FULL_LINES,
+    DRAW,
+    COUNT
+};
+
+constexpr size_t num_profiled_functions =
+    static_cast<size_t>(ProfiledFunction::COUNT);
+
+/**
+ * Returns the number of heap allocations the calling thread has done so far.
+ *
+ * The counting happens in replacements of the global operator new.
+ */
+uint64_t allocation_count();
+
+/**
+ * A Struct for the measurements of a single function.
+ *
+ * The time, allocations and counters are exclusive, they do not contain the
+ * measured functions that are called from this function. Only
+ * total_nanoseconds contains them. The counter values are cycles,
+ * instructions, cache misses and branch misses in this order.
+ */
+struct FunctionProfile {
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t total_nanoseconds = 0;
+    uint64_t allocations = 0;
+    perf_values_t counters{};
+};
+
+struct ProfileScope;
+
+/**
+ * A Struct for collecting the measurements in profile mode.
+ *
+ * Opens the hardware counters for the calling thread with perf_event_open.
+ * If they are not available only the time and the allocations get measured.
+ */
+struct Profiler {
+    /**
+     * Profiler constructor, opens and starts the hardware counters. Without
+     * open_counters the Profiler measures nothing itself and only collects
+     * the results of other Profilers with merge().
+     */
+    explicit Profiler(bool open_counters = true);
+
+    /**
+     * Profiler destructor, closes the hardware counters.
+     */
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * Reads the current values of the hardware counters into values.
+     * The values are zero if the counters are not available.
+     */
+    void read_counters(perf_values_t& values) const;
+
+    /**
+     * Prints calls, exclusive and total time, IPC, misses per piece and
+     * allocations for every function. The number of pieces is the number of
+     * calls of clear_full_lines() because it is called once for every placed
+     * piece.
+     */
+    void report(std::ostream& os) const;
+
+    /**
+     * Adds the measurements of another Profiler, e.g. of another thread.
+     * The counters are only reported if all merged Profilers had them.
+     */
+    void merge(const Profiler& other);
+
+    /**
+     * Variable for the file descriptors of the counters, the first one is
+     * the group leader.
+     */
+    std::array<int, num_perf_counters> fds;
+
+    bool counters_available = false;
+
+    std::array<FunctionProfile, num_profiled_functions> functions{};
+
+    /**
+     * Variable for the innermost running ProfileScope, nullptr if there is
+     * none.
+     */
+    ProfileScope* innermost = nullptr;
+};
+
+/**
+ * Variable for the Profiler that is used by all ProfileScopes of the
+ * calling thread, nullptr if profile mode is off. Other threads like the
+ * Bot are not measured.
+ */
+extern thread_local Profiler* active_profiler;
+
+/**
+ * A Struct that measures a function from its construction until its
+ * destruction. Does nothing if there is no active_profiler.
+ *
+ * Nested scopes add their measurements including their own overhead to the
+ * enclosing scope, which subtracts them from its measurements.
+ */
+struct ProfileScope {
+    explicit ProfileScope(ProfiledFunction f)
+        : function(f), profiler(active_profiler) {
+        if (profiler != nullptr) {
+            start();
+        }
+    }
+
+    ~ProfileScope() {
+        if (profiler != nullptr) {
+            stop();
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    void start();
+    void stop();
+
+    ProfiledFunction function;
+    Profiler* profiler;
+    ProfileScope* parent = nullptr;
+
+    /**
+     * Variable for the time before the counters were read in start(), the
+     * parent uses it to also subtract the overhead of this scope.
+     */
+    std::chrono::steady_clock::time_point enter_time;
+    std::chrono::steady_clock::time_point start_time;
+    uint64_t start_allocations = 0;
+    perf_values_t start_counters{};
+
+    /**
+     * Variables for the measurements of the nested scopes.
+     */
+    uint64_t child_nanoseconds = 0;
+    uint64_t child_allocations = 0;
+    perf_values_t child_counters{};
+};
@@ -0,0 +1,184 @@
+#include "reachability.hpp"
+
+// number of different orientations for every tetromino
+constexpr std::array<int, num_tetrominos> num_distinct_orientations = {
+    2, 1, 4, 2, 2, 4, 4};
+
+constexpr uint16_t encode_state(int line, int col, int orientation) {
+    return static_cast<uint16_t>(
+        (((line + reach_origin_offset) * reach_cols) +
+         (col + reach_origin_offset)) *
+            num_orientations +
+        orientation);
+}
+
+constexpr int line_of(uint16_t state) {
+    return (state / num_orientations) / reach_cols - reach_origin_offset;
+}
+
+constexpr int col_of(uint16_t state) {
+    return (state / num_orientations) % reach_cols - reach_origin_offset;
+}
+
+void Reachability::search(const TetrisGame& game) {
+    search(game.playfield, game.cur_piece);
+}
+
+void Reachability::search(const playfield_t& playfield, const Piece& piece) {
+    for (int ori = 0; ori < num_orientations; ++ori) {
+        cells.at(ori) = orientation_cells(piece.tet_type, ori);
+
+        shapes.at(ori).fill(0);
+        for (const auto& [a, b] : cells.at(ori)) {
+            shapes.at(ori).at(a) |= 1U << b;
+        }
+    }
+    distinct_orientations =
+        num_distinct_orientations.at(static_cast<int>(piece.tet_type));
+
+    constexpr uint32_t field_mask = ((1U << field_width) - 1)
+                                    << reach_wall_cols;
+    occupied.fill(~0U);
+    for (int line = 0; line < field_height; ++line) {
+        uint32_t row = ~field_mask;
+        for (int col = 0; col < field_width; ++col) {
+            // the current piece does not block itself
+            if (playfield.at(line).at(col) != Tetromino::EMPTY &&
+                !same_piece(piece.location, {line, col})) {
+                row |= 1U << (col + reach_wall_cols);
+            }
+        }
+
+        occupied.at(line + reach_origin_offset) = row;
+    }
+
+    // the line where a hard drop lands, from the bottom up
+    for (int ori = 0; ori < num_orientations; ++ori) {
+        for (int col = -reach_origin_offset; col < field_width; ++col) {
+            int land = field_height;
+            for (int line = field_height - 1; line >= -reach_origin_offset;
+                 --line) {
+                if (!fits(line, col, ori)) {
+                    land = field_height;
+                } else if (land == field_height) {
+                    land = line;
+                }
+
+                landing.at(encode_state(line, col, ori)) =
+                    static_cast<int8_t>(land);
+            }
+        }
+    }
+
+    visited.reset();
+    locked.reset();
+    num_visited = 0;
+    num_locks = 0;
+
+    const auto& [first_line, first_col] = piece.location.at(0);
+    const auto& [offset_line, offset_col] = cells.at(piece.orientation).at(0);
+    uint16_t start = encode_state(first_line - offset_line,
+                                  first_col - offset_col, piece.orientation);
+
+    visited.set(start);
+    parent.at(start) = start;
+    parent_move.at(start) = Move::NONE;
+    order.at(num_visited++) = start;
+
+    // the visited states are the queue of the breadth first search
+    for (size_t head = 0; head < num_visited; ++head) {
+        uint16_t state = order.at(head);
+        int line = line_of(state);
+        int col = col_of(state);
+        int ori = orientation_of(state);
+
+        auto visit = [&](int l, int c, int o, Move m) {
+            if (!fits(l, c, o)) {
+                return;
+            }
+
+            uint16_t next = encode_state(l, c, o);
+            if (visited.test(next)) {
+                return;
+            }
+
+            visited.set(next);
+            parent.at(next) = state;
+            parent_move.at(next) = m;
+            order.at(num_visited++) = next;
+        };
+
+        visit(line, col - 1, ori, Move::MOVE_LEFT);
+        visit(line, col + 1, ori, Move::MOVE_RIGHT);
+        visit(line + 1, col, ori, Move::MOVE_DOWN);
+        visit(line, col, (ori + 1) % num_orientations, Move::ROTATE_RIGHT);
+        visit(line, col, (ori + num_orientations - 1) % num_orientations,
+              Move::ROTATE_LEFT);
+
+        // a state below its parent lands where the parent lands
+        if (parent_move.at(state) == Move::MOVE_DOWN) {
+            continue;
+        }
+
+        // a hard drop from here locks the piece where it lands
+        int drop = landing.at(state);
+
+        // orientations that look the same give the same lock position, the
+        // first state in breadth first order has the shortest path
+        uint16_t key = encode_state(drop, col, ori % distinct_orientations);
+        if (!locked.test(key)) {
+            locked.set(key);
+            locks.at(num_locks++) = {encode_state(drop, col, ori), state};
+        }
+    }
+}
+
+size_t Reachability::path_to(size_t lock, path_t& path) const {
+    uint16_t from = locks.at(lock).drop_from;
+
+    size_t length = 0;
+    for (uint16_t s = from; parent.at(s) != s; s = parent.at(s)) {
+        ++length;
+    }
+
+    // one more Move for the hard drop
+    if (length + 1 > max_path_moves) {
+        return 0;
+    }
+
+    path.at(length) = Move::MOVE_UP;
+    size_t i = length;
+    for (uint16_t s = from; parent.at(s) != s; s = parent.at(s)) {
+        path.at(--i) = parent_move.at(s);
+    }
+
+    return length + 1;
+}
+
+location_t Reachability::location_of(uint16_t state) const {
+    location_t l = cells.at(orientation_of(state));
+    for (auto& [a, b] : l) {
+        a += line_of(state);
+        b += col_of(state);
+    }
+
+    return l;
+}
+
+int Reachability::orientation_of(uint16_t state) {
+    return state % num_orientations;
+}
+
+bool Reachability::fits(int line, int col, int orientation) const {
+    const auto& shape = shapes.at(orientation);
+    int shift = col + reach_wall_cols;
+    int first = line + reach_origin_offset;
+
+    // check all lines at once, the result is hard to predict for a branch
+    uint32_t overlap = 0;
+    for (int i = 0; i < num_cells_tetromino; ++i) {
+        overlap |= occupied.at(first + i) & (shape.at(i) << shift);
+    }
+
+    return overlap == 0;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "tetris.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+// the top left corner of a piece can be up to three cells outside of the
+// playfield while all of its cells are inside
+constexpr int reach_origin_offset = 3;
+constexpr int reach_rows = field_height + reach_origin_offset;
+constexpr int reach_cols = field_width + reach_origin_offset;
+constexpr size_t num_reach_states = reach_rows * reach_cols * num_orientations;
+
+constexpr size_t max_path_moves = 64;
+
+// the occupied lines get walls on both sides and extra lines above and below
+// the playfield, so checking a state needs no bounds checks
+constexpr int reach_wall_cols = 4;
+constexpr int reach_padded_lines = field_height + 2 * reach_origin_offset + 1;
+
+using path_t = std::array<Move, max_path_moves>;
+
+/**
+ * A Struct for a position where the current piece can be locked.
+ *
+ * Saves the state of the locked piece and the state from which the shortest
+ * path drops the piece with a hard drop.
+ */
+struct ReachableLock {
+    uint16_t state;
+    uint16_t drop_from;
+};
+
+/**
+ * A Struct for finding all positions the current piece can reach.
+ *
+ * A state is the line and column of the top left corner of the piece
+ * together with its orientation. Starting at the current piece, a breadth
+ * first search tries moving left, right and down and rotating in both
+ * directions with the same rules as move_if_possible(), falldown() and
+ * rotate_if_possible(). Gravity is not taken into account.
+ *
+ * All memory is part of the Struct, so a search does not allocate.
+ */
+struct Reachability {
+    /**
+     * Finds all reachable states and lock positions of the current piece of
+     * the given game.
+     */
+    void search(const TetrisGame& game);
+
+    /**
+     * Finds all reachable states and lock positions of the given piece in
+     * the given playfield. Cells of the piece itself count as empty, so the
+     * piece may or may not be part of the playfield.
+     */
+    void search(const playfield_t& playfield, const Piece& piece);
+
+    /**
+     * Writes the shortest path of Moves to the lock position with the given
+     * index to path, ending with a hard drop. Returns the number of Moves or
+     * zero if the path is longer than max_path_moves.
+     */
+    size_t path_to(size_t lock, path_t& path) const;
+
+    /**
+     * Returns the location of the piece in the given state.
+     */
+    [[nodiscard]] location_t location_of(uint16_t state) const;
+
+    /**
+     * Returns the orientation of the piece in the given state.
+     */
+    [[nodiscard]] static int orientation_of(uint16_t state);
+
+    /**
+     * Checks if the piece fits into the playfield in the given state. Like
+     * is_free() the cells of the current piece count as empty.
+     */
+    [[nodiscard]] bool fits(int line, int col, int orientation) const;
+
+    /**
+     * Variable for the cells of the current piece in every orientation.
+     */
+    std::array<location_t, num_orientations> cells;
+
+    /**
+     * Variable for the cells of the current piece in every orientation as
+     * one bit mask per line of its bounding box.
+     */
+    std::array<std::array<uint32_t, num_cells_tetromino>, num_orientations>
+        shapes;
+
+    /**
+     * Variable for the occupied cells of every line without the current
+     * piece, one bit per column. Cells outside of the playfield are
+     * occupied.
+     */
+    std::array<uint32_t, reach_padded_lines> occupied;
+
+    /**
+     * Variable for the line where a hard drop from a state lands.
+     */
+    std::array<int8_t, num_reach_states> landing;
+
+    std::bitset<num_reach_states> visited;
+    std::bitset<num_reach_states> locked;
+
+    /**
+     * Variable for the state and the Move every visited state was reached
+     * from.
+     */
+    std::array<uint16_t, num_reach_states> parent;
+    std::array<Move, num_reach_states> parent_move;
+
+    /**
+     * Variable for the states in the order they were visited, which is also
+     * the queue of the search.
+     */
+    std::array<uint16_t, num_reach_states> order;
+    size_t num_visited = 0;
+
+    std::array<ReachableLock, num_reach_states> locks;
+    size_t num_locks = 0;
+
+    /**
+     * Variable for the number of different orientations of the current
+     * piece, e.g. all orientations of the O piece look the same.
+     */
+    int distinct_orientations = num_orientations;
+};
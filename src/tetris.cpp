@@ -1,5 +1,7 @@
 #include "tetris.hpp"
 
+#include "profile.hpp"
+
 #include <algorithm>
 // #include <iostream>
 
@@ -67,6 +69,10 @@ constexpr orientations_t orientations = {{
        {{ {0, 1}, {1, 1}, {2, 1}, {2, 2} }} }} }};
 // clang-format on
 
+const location_t& orientation_cells(Tetromino t, int orientation) {
+    return orientations.at(static_cast<int>(t)).at(orientation);
+}
+
 bool same_piece(const location_t& l, const std::pair<int, int>& c) {
     return std::find(l.begin(), l.end(), c) != l.end();
 }
@@ -82,8 +88,10 @@ int ticks_from_level(int level) {
 Piece::Piece(Tetromino type, location_t loc, int ori)
     : tet_type(type), location(std::move(loc)), orientation(ori) {}
 
-TetrisGame::TetrisGame()
-    : mt(std::random_device{}()),
+TetrisGame::TetrisGame() : TetrisGame(std::random_device{}()) {}
+
+TetrisGame::TetrisGame(std::mt19937::result_type seed)
+    : mt(seed),
       playfield(default_playfield),
       cur_piece(generate_piece()),
       next_piece(generate_piece()),
@@ -98,6 +106,23 @@ TetrisGame::TetrisGame()
 }
 
 bool TetrisGame::next_state(Move m) {
+    PROFILE_SCOPE(ProfiledFunction::NEXT_STATE);
+
+    if (!apply_move(m)) {
+        return false;
+    }
+
+    // a hard drop already placed the piece, so no time passes
+    if (m == Move::MOVE_UP) {
+        return true;
+    }
+
+    return tick();
+}
+
+bool TetrisGame::apply_move(Move m) {
+    PROFILE_SCOPE(ProfiledFunction::APPLY_MOVE);
+
     switch (m) {
         case Move::MOVE_LEFT:
             move_if_possible(-1);
@@ -106,10 +131,7 @@ bool TetrisGame::next_state(Move m) {
             move_if_possible(1);
             break;
         case Move::MOVE_DOWN:
-            if (!process_falldown()) {
-                return false;
-            }
-            break;
+            return process_falldown();
         case Move::MOVE_UP:
             while (falldown()) {}
             return process_falldown();
@@ -123,6 +145,12 @@ bool TetrisGame::next_state(Move m) {
             break;
     }
 
+    return true;
+}
+
+bool TetrisGame::tick() {
+    PROFILE_SCOPE(ProfiledFunction::TICK);
+
     // fall down regularly
     if (--ticks_till_falldown == 0) {
         // reset ticks
@@ -186,6 +214,8 @@ void TetrisGame::update_playfield(const location_t& nloc) {
 }
 
 bool TetrisGame::process_falldown() {
+    PROFILE_SCOPE(ProfiledFunction::PROCESS_FALLDOWN);
+
     if (!falldown()) {
         // if falldown() returns false we can try to clear lines
         int lines_cleared = clear_full_lines();
@@ -278,6 +308,8 @@ void TetrisGame::clear_single_line(size_t line) {
 }
 
 int TetrisGame::clear_full_lines() {
+    PROFILE_SCOPE(ProfiledFunction::CLEAR_FULL_LINES);
+
     // count how many lines were cleared
     int counter = 0;
 
@@ -39,6 +39,15 @@ enum class Move {
  */
 bool same_piece(const location_t& l, const std::pair<int, int>& c);
 
+/**
+ * Get the cells of a tetromino in the given orientation relative to the top
+ * left corner of its bounding box.
+ *
+ * Rotating a piece keeps location[i] - orientation_cells(type, ori)[i]
+ * the same for all cells.
+ */
+const location_t& orientation_cells(Tetromino t, int orientation);
+
 /**
  * Get the number of ticks (aka milliseconds) until the piece drops down.
  *
@@ -90,6 +99,12 @@ struct TetrisGame {
      */
     TetrisGame();
 
+    /**
+     * Constructor for a Tetrisgame with a seeded random number generator, so
+     * the same seed always gives the same pieces.
+     */
+    explicit TetrisGame(std::mt19937::result_type seed);
+
     /**
      * Function for processing the user input and handling the falldown.
      *
@@ -100,6 +115,20 @@ struct TetrisGame {
      */
     [[nodiscard]] bool next_state(Move m);
 
+    /**
+     * Does the action for the given Move without letting any time pass.
+     *
+     * Returns false if the move caused the game to be over. This allows
+     * several moves to be applied within one tick.
+     */
+    [[nodiscard]] bool apply_move(Move m);
+
+    /**
+     * Lets one tick pass and drops the current piece one line if
+     * ticks_till_falldown hits zero. Returns false if the game is over.
+     */
+    [[nodiscard]] bool tick();
+
     /**
      * Function for getting the value of a single cell in the playfield.
      */